@@ -6,6 +6,7 @@
 #include "data.hpp"
 #include "event.hpp"
 #include "execution.hpp"
+#include "journal.hpp"
 #include "portfolio.hpp"
 #include "strategy.hpp"
 
@@ -15,57 +16,79 @@ class Backtest : std::enable_shared_from_this<Backtest> {
     SharedStringType csvDirectory;
     std::shared_ptr<double> initialCapital;
     SharedQueueEventType eventQueue;
+    SharedHistoricCSVDataHandler dataHandler;
     InstantExecutionHandler exchange;
     BasicPortfolio portfolio;
-    HistoricCSVDataHandler dataHandler;
-    TradingStrategy strategy;
+    // optional journal of bars and signals, replayed by JournalReplay
+    std::shared_ptr<EventJournalWriter> journal;
 
     Backtest(SharedSymbolsType ptr_symbols, SharedStringType csvDirectory,
              std::shared_ptr<double> initialCapital) {
         this->symbols = *ptr_symbols;
         this->csvDirectory = csvDirectory;
         this->initialCapital = initialCapital;
-        this->dataHandler = HistoricCSVDataHandler(eventQueue, csvDirectory, ptr_symbols);
-        this->exchange = InstantExecutionHandler(eventQueue, &dataHandler);
+        this->eventQueue = std::make_shared<QueueEventType>();
+        this->dataHandler = std::make_shared<HistoricCSVDataHandler>(
+            eventQueue, csvDirectory, ptr_symbols);
+        this->exchange = InstantExecutionHandler(eventQueue, dataHandler);
+        this->portfolio = BasicPortfolio(ptr_symbols, initialCapital, dataHandler);
     };
 
-    void run(std::shared_ptr<TradingStrategy> strategy) {
-        // Load data and update bars
-        dataHandler.loadDataFromMemory();
-        dataHandler.updateBars();
+    // Runs on an existing data handler, e.g. a StreamingCSVDataHandler
+    Backtest(SharedHistoricCSVDataHandler dataHandler,
+             std::shared_ptr<double> initialCapital) {
+        auto ptr_symbols = std::make_shared<SymbolsType>(dataHandler->symbols);
+        this->symbols = *ptr_symbols;
+        this->csvDirectory = std::make_shared<std::string>(dataHandler->csvDirectory);
+        this->initialCapital = initialCapital;
+        this->eventQueue = dataHandler->eventQueue;
+        this->dataHandler = dataHandler;
+        this->exchange = InstantExecutionHandler(eventQueue, dataHandler);
+        this->portfolio = BasicPortfolio(ptr_symbols, initialCapital, dataHandler);
+    };
 
+    void run(std::shared_ptr<TradingStrategy> strategy) {
         std::cout << "Starting backtesting..." << std::endl;
-        while (!eventQueue->empty()) {
-            // get the first event in the queue
-            auto event = eventQueue->front();
-            eventQueue->pop();
 
-            // logic per event type
-            switch (event->type) {
-                case EventType::MARKET: {
-                    strategy->calculateSignals();
-                    portfolio.update();
-                    break;
-                }
-                case EventType::SIGNAL: {
-                    auto signal = std::dynamic_pointer_cast<SignalEvent>(event);
-                    portfolio.onSignal(signal);
-                }
-                case EventType::ORDER: {
-                    auto order = std::dynamic_pointer_cast<OrderEvent>(event); 
-                    exchange.executeOrder(order);
-                    order->logOrder();
-                    break;
-                }
-                case EventType::FILL: {
-                    auto fill = std::dynamic_pointer_cast<FillEvent>(event);
-                    portfolio.onFill(fill);
-                    break;
+        // One MarketEvent per bar, then drain the events it triggered
+        while (dataHandler->bar != dataHandler->data[symbols[0]].end()) {
+            dataHandler->updateBars();
+
+            while (!eventQueue->empty()) {
+                // get the first event in the queue
+                auto event = eventQueue->front();
+                eventQueue->pop();
+
+                // logic per event type
+                switch (event->type) {
+                    case EventType::MARKET: {
+                        if (journal) journal->recordMarket(*dataHandler);
+                        strategy->calculateSignals();
+                        portfolio.update();
+                        break;
+                    }
+                    case EventType::SIGNAL: {
+                        auto signal = std::dynamic_pointer_cast<SignalEvent>(event);
+                        if (journal) journal->recordSignal(*signal);
+                        portfolio.onSignal(signal);
+                        break;
+                    }
+                    case EventType::ORDER: {
+                        auto order = std::dynamic_pointer_cast<OrderEvent>(event);
+                        exchange.executeOrder(order);
+                        order->logOrder();
+                        break;
+                    }
+                    case EventType::FILL: {
+                        auto fill = std::dynamic_pointer_cast<FillEvent>(event);
+                        portfolio.onFill(fill);
+                        break;
+                    }
                 }
             }
         }
 
-        dataHandler.updateBars();
+        if (journal) journal->finish();
         std::cout << "Backtest ended\n Performance metrics\n";
         portfolio.getMetrics();
     };
@@ -0,0 +1,278 @@
+/*
+    Indicator Cache
+
+    Research sessions rerun many backtests over the same symbols, and each run
+    recomputes identical indicator series from identical bars. The cache below
+    memoizes derived series keyed by everything they depend on:
+    (dataset hash, symbol, indicator, parameters, time range).
+
+    When a spill directory is given, every computed series is written to
+    <spillDirectory>/<key hash>.bin and then served from a read-only mmap of
+    that file, also by later runs, so the indicator work is skipped across
+    processes too. Mapped pages belong to the OS page cache, which can drop
+    them under memory pressure, instead of living on the heap.
+
+    The cache keeps at most `memoryBudget` bytes of series referenced, evicting
+    the least recently used ones. Evicted series stay valid for callers that
+    still hold them, and are re-mapped from disk (or recomputed without a spill
+    directory) on the next lookup.
+*/
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "data.hpp"
+
+// Derived series, one value per bar of the keyed range
+using IndicatorSeriesType = std::vector<double>;
+
+/*
+ * Read-only view over a cached series
+ *
+ * Values live either in a heap vector or in a file mapping; `storage` keeps
+ * whichever it is alive for as long as the view is referenced.
+ */
+class IndicatorSeries {
+   public:
+    IndicatorSeries(std::shared_ptr<const void> storage, const double* values,
+                    std::size_t length) {
+        this->storage = storage;
+        this->values = values;
+        this->length = length;
+    };
+
+    static std::shared_ptr<const IndicatorSeries> fromVector(IndicatorSeriesType values) {
+        auto storage = std::make_shared<const IndicatorSeriesType>(std::move(values));
+        return std::make_shared<const IndicatorSeries>(storage, storage->data(),
+                                                       storage->size());
+    };
+
+    std::size_t size() const { return length; }
+    const double& operator[](std::size_t i) const { return values[i]; }
+    const double* begin() const { return values; }
+    const double* end() const { return values + length; }
+
+   private:
+    std::shared_ptr<const void> storage;
+    const double* values;
+    std::size_t length;
+};
+
+using SharedIndicatorSeriesType = std::shared_ptr<const IndicatorSeries>;
+
+/*
+ * Identifies a derived series by all of its inputs
+ */
+class IndicatorKey {
+   public:
+    std::uint64_t datasetHash;       // Content hash of the source bars
+    std::string symbol;              // Financial instrument
+    std::string indicator;           // Indicator name, e.g. "RSI"
+    std::vector<double> parameters;  // Indicator parameters, e.g. {lookback}
+    long long firstTimestamp;        // First bar of the range
+    long long lastTimestamp;         // Last bar of the range
+
+    // Canonical textual form, also stored in spill files to detect collisions
+    std::string toString() const {
+        std::ostringstream ss;
+        ss.precision(17);
+        ss << datasetHash << '|' << symbol << '|' << indicator << '|';
+        for (auto parameter : parameters) ss << parameter << ',';
+        ss << '|' << firstTimestamp << '|' << lastTimestamp;
+        return ss.str();
+    };
+};
+
+/*
+ * Content-addressed, thread-safe cache of indicator series
+ */
+class IndicatorCache {
+   public:
+    std::string spillDirectory;  // Empty for an in-memory only cache
+    std::size_t memoryBudget;    // Bytes of series kept referenced, 0 for unlimited
+
+    IndicatorCache(std::string spillDirectory = "", std::size_t memoryBudget = 0) {
+        this->spillDirectory = spillDirectory;
+        this->memoryBudget = memoryBudget;
+    };
+
+    // Returns the cached series, or nullptr if it was never stored
+    SharedIndicatorSeriesType find(const IndicatorKey& key) {
+        auto keyString = key.toString();
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = entries.find(keyString);
+            if (it != entries.end()) {
+                recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, it->second.lruPosition);
+                return it->second.series;
+            }
+        }
+
+        auto loaded = loadFromDisk(keyString);
+        if (loaded) insert(keyString, loaded);
+        return loaded;
+    };
+
+    // Stores a series; with a spill directory the returned series is backed
+    // by the file mapping and the heap copy is released
+    SharedIndicatorSeriesType store(const IndicatorKey& key, IndicatorSeriesType values) {
+        auto keyString = key.toString();
+        SharedIndicatorSeriesType series = nullptr;
+        if (writeToDisk(keyString, values)) series = loadFromDisk(keyString);
+        if (!series) series = IndicatorSeries::fromVector(std::move(values));
+
+        insert(keyString, series);
+        return series;
+    };
+
+    // Returns the cached series, computing and storing it on a miss
+    // `compute` is called without arguments and returns an IndicatorSeriesType
+    template <typename ComputeFunction>
+    SharedIndicatorSeriesType getOrCompute(const IndicatorKey& key,
+                                           ComputeFunction compute) {
+        auto cached = find(key);
+        if (cached) return cached;
+        return store(key, compute());
+    };
+
+    std::size_t size() {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return entries.size();
+    };
+
+    std::size_t residentBytes() {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return bytesInCache;
+    };
+
+   private:
+    // Spill file layout: magic, key length, key, value count, zero padding
+    // to an 8-byte boundary, values (so the mapping can be read in place)
+    static constexpr char spillMagic[4] = {'L', 'T', 'I', 'C'};
+
+    struct Entry {
+        SharedIndicatorSeriesType series;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    std::mutex cacheMutex;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recentlyUsed;  // Most recently used first
+    std::size_t bytesInCache = 0;
+
+    void insert(const std::string& keyString, SharedIndicatorSeriesType series) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = entries.find(keyString);
+        if (it != entries.end()) {
+            bytesInCache -= it->second.series->size() * sizeof(double);
+            recentlyUsed.erase(it->second.lruPosition);
+            entries.erase(it);
+        }
+
+        recentlyUsed.push_front(keyString);
+        entries[keyString] = Entry{series, recentlyUsed.begin()};
+        bytesInCache += series->size() * sizeof(double);
+
+        // Evict least recently used series, always keeping the new one
+        while (memoryBudget > 0 && bytesInCache > memoryBudget && entries.size() > 1) {
+            auto evicted = entries.find(recentlyUsed.back());
+            bytesInCache -= evicted->second.series->size() * sizeof(double);
+            entries.erase(evicted);
+            recentlyUsed.pop_back();
+        }
+    };
+
+    static std::size_t valuesOffset(std::size_t keyLength) {
+        std::size_t header = sizeof(spillMagic) + 2 * sizeof(std::uint64_t) + keyLength;
+        return (header + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    };
+
+    std::string spillPath(const std::string& keyString) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin",
+                      static_cast<unsigned long long>(
+                          hashBytes(keyString.data(), keyString.size())));
+        return spillDirectory + "/" + name;
+    };
+
+    // Writes to a temporary file first so concurrent runs never map a
+    // partially written series. Returns true once the file is in place.
+    bool writeToDisk(const std::string& keyString, const IndicatorSeriesType& values) const {
+        if (spillDirectory.empty()) return false;
+
+        auto path = spillPath(keyString);
+        auto tmpPath = path + "." + std::to_string(::getpid()) + ".tmp";
+        std::ofstream file(tmpPath, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        std::uint64_t keyLength = keyString.size(), count = values.size();
+        std::size_t header = sizeof(spillMagic) + 2 * sizeof(std::uint64_t) + keyLength;
+        const char padding[sizeof(double)] = {};
+        file.write(spillMagic, sizeof(spillMagic));
+        file.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+        file.write(keyString.data(), keyLength);
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        file.write(padding, valuesOffset(keyLength) - header);
+        file.write(reinterpret_cast<const char*>(values.data()), count * sizeof(double));
+        file.close();
+
+        if (!file || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    };
+
+    // Maps a spill file and returns a series reading the values in place
+    SharedIndicatorSeriesType loadFromDisk(const std::string& keyString) const {
+        if (spillDirectory.empty()) return nullptr;
+
+        int fd = ::open(spillPath(keyString).c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return nullptr;
+        }
+        std::size_t fileSize = static_cast<std::size_t>(info.st_size);
+        void* mapped = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) return nullptr;
+
+        std::shared_ptr<const void> mapping(mapped, [fileSize](const void* address) {
+            ::munmap(const_cast<void*>(address), fileSize);
+        });
+        const char* bytes = static_cast<const char*>(mapped);
+
+        std::uint64_t keyLength = 0, count = 0;
+        std::size_t keyOffset = sizeof(spillMagic) + sizeof(keyLength);
+        if (fileSize < keyOffset || std::memcmp(bytes, spillMagic, 4) != 0) return nullptr;
+        std::memcpy(&keyLength, bytes + sizeof(spillMagic), sizeof(keyLength));
+        if (keyLength != keyString.size() || fileSize < valuesOffset(keyLength) ||
+            std::memcmp(bytes + keyOffset, keyString.data(), keyLength) != 0)
+            return nullptr;
+
+        std::memcpy(&count, bytes + keyOffset + keyLength, sizeof(count));
+        auto offset = valuesOffset(keyLength);
+        if ((fileSize - offset) / sizeof(double) < count) return nullptr;
+
+        return std::make_shared<const IndicatorSeries>(
+            mapping, reinterpret_cast<const double*>(bytes + offset),
+            static_cast<std::size_t>(count));
+    };
+};
@@ -10,12 +10,19 @@
     This implementation focuses on historical backtesting with CSV data.
 */
 #pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -46,6 +53,34 @@ using SharedQueueEventType = std::shared_ptr<QueueEventType>;
 using SymbolsType = std::vector<std::string>;
 using SharedSymbolsType = std::shared_ptr<SymbolsType>;
 
+// 64-bit FNV-1a hash, stable across runs and platforms
+// Chain calls through `hash` to hash data incrementally
+inline std::uint64_t hashBytes(const char* bytes, std::size_t length,
+                               std::uint64_t hash = 14695981039346656037ULL) {
+    for (std::size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(bytes[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Parses a single CSV row into <timestamp, [open, high, low, close, volume]>
+// Expected columns:
+// timestamp, symbol, exchange, open, high, low, close, adjusted_close, volume
+inline HistoricalDataType::value_type parseCSVBar(const std::string& line) {
+    std::stringstream ss(line);
+    std::string lineItems;
+    std::vector<std::string> lineVector;
+
+    while (std::getline(ss, lineItems, ',')) {
+        lineVector.emplace_back(lineItems);
+    }
+    return {std::stoll(lineVector[0]),
+            std::make_tuple(std::stod(lineVector[3]), std::stod(lineVector[4]),
+                            std::stod(lineVector[5]), std::stod(lineVector[6]),
+                            std::stod(lineVector[8]))};
+}
+
 /*
  * Abstract DataHandler class that defines the interface for all data handlers
  */
@@ -83,6 +118,10 @@ class HistoricCSVDataHandler
     // Iterator over the historical data contained in data
     HistoricalDataType::iterator bar;
 
+    // Content hash of the loaded file, 0 while unknown
+    // Used to key derived series (see IndicatorCache)
+    std::uint64_t datasetHash = 0;
+
     HistoricCSVDataHandler(SharedQueueEventType eventQueue,
                            SharedStringType csvDirectory,
                            SharedSymbolsType symbols) {
@@ -102,23 +141,18 @@ class HistoricCSVDataHandler
         std::ifstream fileToLoad(csvDirectory, std::ios::binary);
         if (!fileToLoad.is_open()) throw std::runtime_error("Could not load file");
 
-        std::string line, lineItems;
+        std::string line;
         HistoricalDataType innerMap;
         std::getline(fileToLoad, line); // Skip header row
+        std::uint64_t hash = hashBytes(line.data(), line.size());
+        hash = hashBytes("\n", 1, hash);
 
         while (std::getline(fileToLoad, line)) {
-            std::stringstream ss(line);
-            std::vector<std::string> lineVector;
-
-            while (std::getline(ss, lineItems, ',')) {
-                lineVector.emplace_back(lineItems);
-            }
-            innerMap.insert(
-                {std::stoll(lineVector[0]),
-                 std::make_tuple(std::stod(lineVector[3]), std::stod(lineVector[4]),
-                                 std::stod(lineVector[5]), std::stod(lineVector[6]),
-                                 std::stod(lineVector[8]))});
+            hash = hashBytes(line.data(), line.size(), hash);
+            hash = hashBytes("\n", 1, hash);
+            innerMap.insert(parseCSVBar(line));
         }
+        this->datasetHash = hash;
 
         this->data.insert(std::make_pair(symbols[0], innerMap));
         this->bar = data[symbols[0]].begin();
@@ -155,3 +189,194 @@ class HistoricCSVDataHandler
         eventQueue->push(std::make_shared<MarketEvent>());
     };
 };
+
+/*
+ * Out-of-core variant of HistoricCSVDataHandler for datasets larger than RAM
+ *
+ * Instead of loading the whole file up front, a background I/O thread parses
+ * fixed-size chunks of rows ahead of the simulation cursor and hands them over
+ * through a bounded buffer (numBuffers = 2 for double, 3 for triple buffering).
+ * Bars are dropped from `data` once consumed, and `consumedData` only retains
+ * the last `maxLookback` bars, so peak memory is bounded by
+ * numBuffers * chunkSize + maxLookback bars regardless of the file size.
+ *
+ * It keeps the `data`, `consumedData` and `bar` members of its parent, so it
+ * can be passed wherever a SharedHistoricCSVDataHandler is expected,
+ * including Backtest(dataHandler, initialCapital).
+ * Strategies must not request more than `maxLookback` bars. The whole file
+ * is never in memory, so datasetHash stays 0 and indicator caching is off.
+ *
+ * Unlike the parent, which sorts the whole file, bars are only sorted within
+ * a chunk: the CSV must be in ascending timestamp order, and a chunk starting
+ * at or before the last delivered timestamp raises a runtime_error.
+ */
+class StreamingCSVDataHandler : public HistoricCSVDataHandler {
+   public:
+    std::size_t chunkSize;    // Rows parsed per chunk by the I/O thread
+    std::size_t numBuffers;   // Chunks in memory (consumed + queued + being parsed)
+    std::size_t maxLookback;  // Bars retained in consumedData per symbol
+
+    StreamingCSVDataHandler(SharedQueueEventType eventQueue,
+                            SharedStringType csvDirectory,
+                            SharedSymbolsType symbols,
+                            std::size_t chunkSize = 4096,
+                            std::size_t numBuffers = 3,
+                            std::size_t maxLookback = 256) {
+        this->eventQueue = eventQueue;
+        this->csvDirectory = *csvDirectory;
+        this->symbols = *symbols;
+        this->chunkSize = chunkSize > 0 ? chunkSize : 1;
+        this->numBuffers = numBuffers > 1 ? numBuffers : 2;
+        this->maxLookback = maxLookback > 0 ? maxLookback : 1;
+
+        loadDataFromMemory();
+    };
+
+    StreamingCSVDataHandler(const StreamingCSVDataHandler&) = delete;
+    StreamingCSVDataHandler& operator=(const StreamingCSVDataHandler&) = delete;
+
+    ~StreamingCSVDataHandler() { stopIOThread(); };
+
+    // Opens the CSV file and starts the background I/O thread, then blocks
+    // until the first chunk is available so that `bar` is valid on return.
+    // Calling it again once streaming has started is a no-op.
+    void loadDataFromMemory() {
+        if (ioThread.joinable()) return;
+
+        std::ifstream fileToLoad(csvDirectory, std::ios::binary);
+        if (!fileToLoad.is_open()) throw std::runtime_error("Could not load file");
+
+        std::string line;
+        std::getline(fileToLoad, line); // Skip header row
+
+        this->data[symbols[0]] = HistoricalDataType();
+        this->consumedData[symbols[0]] = HistoricalDataType();
+        this->bar = data[symbols[0]].end();
+
+        ioThread = std::thread(&StreamingCSVDataHandler::readChunks, this,
+                               std::move(fileToLoad));
+
+        // The destructor does not run if the constructor throws, so the
+        // I/O thread has to be joined here before propagating the error
+        try {
+            fetchNextChunk();
+        } catch (...) {
+            stopIOThread();
+            throw;
+        }
+    };
+
+    // Moves the current bar into consumedData, releases bars that fall
+    // outside the lookback window and swaps in the next prefetched chunk
+    // when the current one is exhausted.
+    void updateBars() {
+        auto& window = data[symbols[0]];
+        auto& consumed = consumedData[symbols[0]];
+
+        if (bar != window.end()) {
+            consumed[bar->first] = bar->second;
+            bar = window.erase(bar);
+            while (consumed.size() > maxLookback) consumed.erase(consumed.begin());
+        }
+        if (bar == window.end()) fetchNextChunk();
+
+        // Generate a MarketEvent to notify the system of new data
+        eventQueue->push(std::make_shared<MarketEvent>());
+    };
+
+   private:
+    std::thread ioThread;
+    std::mutex bufferMutex;
+    std::condition_variable chunkAvailable;
+    std::condition_variable bufferSpaceAvailable;
+    std::deque<HistoricalDataType> readyChunks;  // Prefetched, not yet consumed
+    std::exception_ptr ioError;                  // Parse error raised by ioThread
+    bool readingDone = false;
+    bool stopReading = false;
+    bool anyChunkDelivered = false;
+    long long lastDeliveredTimestamp = 0;
+
+    void stopIOThread() {
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            stopReading = true;
+        }
+        bufferSpaceAvailable.notify_all();
+        if (ioThread.joinable()) ioThread.join();
+    };
+
+    // Waits for the I/O thread to deliver the next chunk and swaps it into
+    // the (empty) current window. Returns false once the file is exhausted.
+    bool fetchNextChunk() {
+        HistoricalDataType chunk;
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            chunkAvailable.wait(lock, [this] {
+                return !readyChunks.empty() || readingDone;
+            });
+            if (readyChunks.empty()) {
+                if (ioError) std::rethrow_exception(ioError);
+                return false;
+            }
+            chunk = std::move(readyChunks.front());
+            readyChunks.pop_front();
+        }
+        bufferSpaceAvailable.notify_one();
+
+        if (anyChunkDelivered && chunk.begin()->first <= lastDeliveredTimestamp)
+            throw std::runtime_error("CSV rows must be sorted by timestamp to be streamed");
+        anyChunkDelivered = true;
+        lastDeliveredTimestamp = chunk.rbegin()->first;
+
+        auto& window = data[symbols[0]];
+        window.swap(chunk);
+        bar = window.begin();
+        return true;
+    };
+
+    // Body of the I/O thread: parses chunkSize rows at a time and keeps at
+    // most numBuffers - 1 chunks, queued or being parsed, ahead of the one
+    // being consumed. A chunk is only parsed once its slot is free, so
+    // parsing never holds an extra chunk in memory while waiting for space.
+    void readChunks(std::ifstream fileToLoad) {
+        std::string line;
+        bool endOfFile = false;
+
+        try {
+            while (!endOfFile) {
+                {
+                    std::unique_lock<std::mutex> lock(bufferMutex);
+                    bufferSpaceAvailable.wait(lock, [this] {
+                        return readyChunks.size() < numBuffers - 1 || stopReading;
+                    });
+                    if (stopReading) break;
+                }
+
+                // This thread is the only producer, so the slot stays free
+                HistoricalDataType chunk;
+                while (chunk.size() < chunkSize) {
+                    if (!std::getline(fileToLoad, line)) {
+                        endOfFile = true;
+                        break;
+                    }
+                    if (!line.empty()) chunk.insert(parseCSVBar(line));
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(bufferMutex);
+                    if (!chunk.empty()) readyChunks.emplace_back(std::move(chunk));
+                }
+                chunkAvailable.notify_one();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            ioError = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            readingDone = true;
+        }
+        chunkAvailable.notify_all();
+    };
+};
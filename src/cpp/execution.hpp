@@ -25,8 +25,12 @@ class InstantExecutionHandler : ExecutionHandler {
 
     InstantExecutionHandler() = default;
 
+    // Fills at the next bar, or at the latest consumed one on the last bar
     void executeOrder(SharedOrderType order) {
-        auto timestamp = dataHandler->bar->first;
+        auto& symbol = dataHandler->symbols[0];
+        auto timestamp = dataHandler->bar != dataHandler->data[symbol].end()
+                             ? dataHandler->bar->first
+                             : dataHandler->consumedData[symbol].rbegin()->first;
         eventQueue->push(std::make_shared<FillEvent>(
             &order->symbol, &timestamp, &order->quantity, order->direction, 0,
             order->target));
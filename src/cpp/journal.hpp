@@ -0,0 +1,375 @@
+/*
+    Event Journal
+
+    Most research iterations only change downstream logic (position sizing in
+    the Portfolio, fill model in the ExecutionHandler), yet every iteration
+    re-parses the data and re-runs the strategy. The journal records, once,
+    the stream of signals together with the bars they referenced, in a
+    compact binary format:
+
+    header:  "LTEJ", uint32 version, uint32 symbol count,
+             per symbol: uint16 length + name
+    records: 'M'                                          (one per MarketEvent)
+             'B' uint32 symbol, int64 timestamp, 5 x double (OHLCV per symbol)
+             'S' uint32 symbol, int64 timestamp, double signal,
+                 uint16 length + target                   (one per SignalEvent)
+    trailer: 'E' uint64 number of 'M' records
+
+    A replay feeds the journal straight into the Portfolio and the
+    ExecutionHandler, skipping CSV parsing and strategy evaluation.
+    Values are written in native byte order. The trailer is written by
+    finish() once the run is complete, which also reports write errors (e.g.
+    a full disk); replaying a journal without it throws, so a partial run is
+    never mistaken for a complete one.
+*/
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "data.hpp"
+#include "event.hpp"
+#include "execution.hpp"
+#include "portfolio.hpp"
+
+static constexpr char journalMagic[4] = {'L', 'T', 'E', 'J'};
+static constexpr std::uint32_t journalVersion = 3;
+
+enum JournalRecordType : char {
+    JOURNAL_MARKET = 'M',
+    JOURNAL_BAR = 'B',
+    JOURNAL_SIGNAL = 'S',
+    JOURNAL_END = 'E'
+};
+
+/*
+ * Records market steps and signals of a backtest run
+ */
+class EventJournalWriter {
+   public:
+    EventJournalWriter(std::string journalPath, const SymbolsType& symbols) {
+        file.open(journalPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) throw std::runtime_error("Could not open journal");
+
+        file.write(journalMagic, sizeof(journalMagic));
+        write(journalVersion);
+        write(static_cast<std::uint32_t>(symbols.size()));
+        for (std::uint32_t i = 0; i < symbols.size(); ++i) {
+            writeString(symbols[i]);
+            symbolIndex[symbols[i]] = i;
+        }
+    };
+
+    // Records a MarketEvent with the latest consumed bar of every symbol
+    void recordMarket(const HistoricCSVDataHandler& dataHandler) {
+        auto& latest = dataHandler.consumedData.at(dataHandler.symbols[0]);
+        if (latest.empty()) return;
+
+        file.put(JOURNAL_MARKET);
+        ++marketSteps;
+        for (auto& symbol : dataHandler.symbols) {
+            auto& bars = dataHandler.consumedData.at(symbol);
+            if (bars.empty()) continue;
+            auto& bar = bars.rbegin()->second;
+
+            file.put(JOURNAL_BAR);
+            write(symbolIndex.at(symbol));
+            write(bars.rbegin()->first);
+            write(std::get<0>(bar));
+            write(std::get<1>(bar));
+            write(std::get<2>(bar));
+            write(std::get<3>(bar));
+            write(std::get<4>(bar));
+        }
+    };
+
+    void recordSignal(const SignalEvent& signal) {
+        auto index = symbolIndex.find(signal.symbol);
+        if (index == symbolIndex.end())
+            throw std::runtime_error("Signal on unknown symbol " + signal.symbol);
+
+        file.put(JOURNAL_SIGNAL);
+        write(index->second);
+        write(signal.timestamp);
+        write(signal.signal);
+        writeString(signal.target);
+    };
+
+    // Throws if any record could not be written since the journal opened
+    void flush() {
+        file.flush();
+        if (!file) {
+            failureReported = true;
+            throw std::runtime_error("Could not write journal");
+        }
+    };
+
+    // Marks the run as complete; no records may follow
+    void finish() {
+        if (finished) throw std::logic_error("Journal is already finished");
+        file.put(JOURNAL_END);
+        write(marketSteps);
+        finished = true;
+        flush();
+    };
+
+    // Destructors must not throw: report an unfinished or failed journal instead
+    ~EventJournalWriter() {
+        file.flush();
+        if (failureReported) return;
+        if (!file)
+            std::cerr << "Could not write journal, it is incomplete" << std::endl;
+        else if (!finished)
+            std::cerr << "Journal closed before finish(), it is incomplete" << std::endl;
+    };
+
+   private:
+    std::ofstream file;
+    std::unordered_map<std::string, std::uint32_t> symbolIndex;
+    bool failureReported = false;
+    bool finished = false;
+    std::uint64_t marketSteps = 0;
+
+    template <typename T>
+    void write(const T& value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    };
+
+    void writeString(const std::string& value) {
+        write(static_cast<std::uint16_t>(value.size()));
+        file.write(value.data(), static_cast<std::uint16_t>(value.size()));
+    };
+};
+
+/*
+ * DataHandler that replays the bars and signals of a journal
+ *
+ * Every updateBars() consumes one recorded market step: the bars go into
+ * consumedData (trimmed to maxLookback) and a MarketEvent followed by the
+ * recorded SignalEvents is pushed onto the eventQueue, in the order the
+ * original run produced them. The journal is read sequentially, only the
+ * next step is held in `data`, and `bar` points to it as in the parent.
+ */
+class JournalReplayDataHandler : public HistoricCSVDataHandler {
+   public:
+    std::size_t maxLookback;  // Bars retained in consumedData per symbol
+
+    JournalReplayDataHandler(SharedQueueEventType eventQueue,
+                             SharedStringType journalPath,
+                             std::size_t maxLookback = 256) {
+        this->eventQueue = eventQueue;
+        this->csvDirectory = *journalPath;
+        this->maxLookback = maxLookback;
+
+        loadDataFromMemory();
+    };
+
+    // Reads the journal header and the first market step
+    void loadDataFromMemory() {
+        if (file.is_open()) return;
+
+        file.open(csvDirectory, std::ios::binary);
+        if (!file.is_open()) throw std::runtime_error("Could not load journal");
+
+        char magic[4];
+        std::uint32_t version = 0, symbolCount = 0;
+        file.read(magic, sizeof(magic));
+        read(version);
+        read(symbolCount);
+        if (!file || std::string(magic, 4) != std::string(journalMagic, 4) ||
+            version != journalVersion)
+            throw std::runtime_error("Invalid journal header");
+
+        symbols.clear();
+        for (std::uint32_t i = 0; i < symbolCount; ++i) {
+            symbols.emplace_back(readString());
+            data[symbols.back()] = HistoricalDataType();
+            consumedData[symbols.back()] = HistoricalDataType();
+        }
+        if (symbols.empty()) throw std::runtime_error("Journal has no symbols");
+
+        if (!readStep()) throw std::runtime_error("Journal has no market steps");
+        bar = data[symbols[0]].begin();
+    };
+
+    // True once the last recorded step has been consumed
+    bool finished() const { return exhausted; };
+
+    void updateBars() {
+        if (exhausted) return;
+
+        for (auto& symbol : symbols) {
+            auto& consumed = consumedData[symbol];
+            for (auto& nextBar : data[symbol]) consumed[nextBar.first] = nextBar.second;
+            while (consumed.size() > maxLookback) consumed.erase(consumed.begin());
+        }
+
+        eventQueue->push(std::make_shared<MarketEvent>());
+        for (auto& signal : nextSignals) eventQueue->push(signal);
+
+        // On the last step `bar` keeps pointing to the consumed bar, so fills
+        // generated by its signals still have a valid timestamp
+        if (readStep()) {
+            bar = data[symbols[0]].begin();
+        } else {
+            exhausted = true;
+        }
+    };
+
+   private:
+    std::ifstream file;
+    std::vector<std::shared_ptr<Event>> nextSignals;
+    bool exhausted = false;
+    std::uint64_t stepsRead = 0;
+
+    template <typename T>
+    void read(T& value) {
+        file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    };
+
+    std::string readString() {
+        std::uint16_t length = 0;
+        read(length);
+        std::string value(length, '\0');
+        file.read(&value[0], length);
+        return value;
+    };
+
+    // A record cut short by the end of the file means the run was interrupted
+    void checkRecord() {
+        if (file) return;
+        if (file.eof()) throw std::runtime_error("Journal is incomplete");
+        throw std::runtime_error("Corrupted journal");
+    };
+
+    const std::string& symbolAt(std::uint32_t index) {
+        if (index >= symbols.size()) throw std::runtime_error("Corrupted journal");
+        return symbols[index];
+    };
+
+    // Reads the records of the next market step into `data` and nextSignals
+    // Returns false, leaving them untouched, at the end record of the journal
+    bool readStep() {
+        auto type = file.peek();
+        if (type == std::char_traits<char>::eof())
+            throw std::runtime_error("Journal is incomplete");
+        if (type == JOURNAL_END) {
+            file.get();
+            std::uint64_t recordedSteps = 0;
+            read(recordedSteps);
+            checkRecord();
+            if (recordedSteps != stepsRead || file.peek() != std::char_traits<char>::eof())
+                throw std::runtime_error("Corrupted journal");
+            return false;
+        }
+        if (type != JOURNAL_MARKET) throw std::runtime_error("Corrupted journal");
+        file.get();
+
+        long long timestamp;
+        SymbolHistoricalDataType stepBars;
+        std::vector<std::shared_ptr<Event>> stepSignals;
+        while ((type = file.peek()) == JOURNAL_BAR || type == JOURNAL_SIGNAL) {
+            file.get();
+            std::uint32_t index;
+            read(index);
+            read(timestamp);
+            checkRecord();
+            std::string symbol = symbolAt(index);
+
+            if (type == JOURNAL_BAR) {
+                double open, high, low, close, volume;
+                read(open);
+                read(high);
+                read(low);
+                read(close);
+                read(volume);
+                stepBars[symbol][timestamp] =
+                    std::make_tuple(open, high, low, close, volume);
+            } else {
+                double signal;
+                read(signal);
+                auto target = readString();
+                stepSignals.emplace_back(
+                    std::make_shared<SignalEvent>(&symbol, &timestamp, signal, target));
+            }
+            checkRecord();
+        }
+        if (type == std::char_traits<char>::eof())
+            throw std::runtime_error("Journal is incomplete");
+        if (type != JOURNAL_MARKET && type != JOURNAL_END)
+            throw std::runtime_error("Corrupted journal");
+
+        for (auto& symbol : symbols) data[symbol] = std::move(stepBars[symbol]);
+        nextSignals = std::move(stepSignals);
+        ++stepsRead;
+        return true;
+    };
+};
+
+/*
+ * Replays a journal through a Portfolio and an ExecutionHandler
+ *
+ * Mirrors the event loop of Backtest without data parsing or strategy
+ * evaluation. Portfolio and execution types are template parameters so
+ * downstream-only variants (position sizing, fill models) can be compared on
+ * the same journal.
+ */
+template <typename PortfolioType = BasicPortfolio,
+          typename ExecutionHandlerType = InstantExecutionHandler>
+class JournalReplay {
+   public:
+    SharedQueueEventType eventQueue;
+    std::shared_ptr<JournalReplayDataHandler> dataHandler;
+    std::shared_ptr<SymbolsType> symbols;
+    std::shared_ptr<double> initialCapital;
+    PortfolioType portfolio;
+    ExecutionHandlerType exchange;
+
+    JournalReplay(SharedStringType journalPath, std::shared_ptr<double> initialCapital) {
+        this->eventQueue = std::make_shared<QueueEventType>();
+        this->dataHandler =
+            std::make_shared<JournalReplayDataHandler>(eventQueue, journalPath);
+        this->symbols = std::make_shared<SymbolsType>(dataHandler->symbols);
+        this->initialCapital = initialCapital;
+        this->portfolio = PortfolioType(symbols, initialCapital, dataHandler);
+        this->exchange = ExecutionHandlerType(eventQueue, dataHandler);
+    };
+
+    void run() {
+        while (!dataHandler->finished()) {
+            dataHandler->updateBars();
+
+            while (!eventQueue->empty()) {
+                auto event = eventQueue->front();
+                eventQueue->pop();
+
+                switch (event->type) {
+                    case EventType::MARKET: {
+                        portfolio.update();
+                        break;
+                    }
+                    case EventType::SIGNAL: {
+                        auto signal = std::dynamic_pointer_cast<SignalEvent>(event);
+                        portfolio.onSignal(signal);
+                        break;
+                    }
+                    case EventType::ORDER: {
+                        auto order = std::dynamic_pointer_cast<OrderEvent>(event);
+                        exchange.executeOrder(order);
+                        break;
+                    }
+                    case EventType::FILL: {
+                        auto fill = std::dynamic_pointer_cast<FillEvent>(event);
+                        portfolio.onFill(fill);
+                        break;
+                    }
+                }
+            }
+        }
+    };
+};
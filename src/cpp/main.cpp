@@ -25,9 +25,7 @@ int main(int argc, char **argv) {
     symbols->push_back("APPL");
     auto backtest = Backtest(symbols, csvDirectory, initialCapital);
 
-    auto dataHandler =
-        std::make_shared<HistoricCSVDataHandler>(backtest.dataHandler);
-    auto trading_strategy = std::make_shared<TradingStrategy>(dataHandler);
+    auto trading_strategy = std::make_shared<TradingStrategy>(backtest.dataHandler);
 
     std::cout << "Running backtest..." << std::endl;
     auto start = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,521 @@
+/*
+    Option Pricing Engine
+
+    Native counterpart of examples/scripts/AmericanVanillaOption.py, meant to
+    price (and compute Greeks for) thousands of American vanilla contracts at
+    every bar, e.g. to mark option holdings hedging the equity positions held
+    by BasicPortfolio.
+
+    Contracts are passed as a struct-of-arrays batch so the inner loops run
+    over contiguous memory, and batches are split across worker threads.
+    Two pricers are provided:
+    1. BinomialOptionPricer: Cox-Ross-Rubinstein lattice (Hull, Options,
+       futures and other derivatives, ch. 13), Greeks read off the tree
+    2. LongstaffSchwartzOptionPricer: least-squares Monte Carlo (Longstaff &
+       Schwartz, 2001), delta and vega by bump-and-reprice with common random
+       numbers, gamma and theta from a lattice
+*/
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ * Batch of option contracts in struct-of-arrays layout
+ *
+ * Inputs are filled by the caller (one entry per contract), outputs are
+ * resized and overwritten by OptionPricer::priceBatch.
+ */
+class OptionBatch {
+   public:
+    // Inputs
+    std::vector<double> spot;        // Price of the underlying
+    std::vector<double> strike;      // Strike price
+    std::vector<double> maturity;    // Time to maturity in years
+    std::vector<double> rate;        // Risk-free rate (continuous)
+    std::vector<double> dividend;    // Dividend yield (continuous)
+    std::vector<double> volatility;  // Annualised volatility
+    std::vector<int> isCall;         // 1 for CALL, 0 for PUT
+    std::vector<std::uint64_t> contractId;  // Stable id, seeds Monte Carlo pricers
+
+    // Id given to the next contract added
+    std::uint64_t nextContractId = 0;
+
+    // Outputs
+    std::vector<double> price;
+    std::vector<double> delta;  // dV/dS
+    std::vector<double> gamma;  // d2V/dS2
+    std::vector<double> theta;  // dV/dt (per year)
+    std::vector<double> vega;   // dV/dsigma
+
+    std::size_t size() const { return spot.size(); }
+
+    // Returns the id of the added contract; it stays attached to the contract
+    // when others are erased, so its random stream does not change
+    std::uint64_t add(double spot, double strike, double maturity, double rate,
+                      double dividend, double volatility, bool isCall) {
+        this->spot.push_back(spot);
+        this->strike.push_back(strike);
+        this->maturity.push_back(maturity);
+        this->rate.push_back(rate);
+        this->dividend.push_back(dividend);
+        this->volatility.push_back(volatility);
+        this->isCall.push_back(isCall ? 1 : 0);
+        this->contractId.push_back(nextContractId);
+        return nextContractId++;
+    };
+
+    // removes contract i, keeping the order of the others
+    void erase(std::size_t i) {
+        for (auto* column : {&spot, &strike, &maturity, &rate, &dividend, &volatility,
+                             &price, &delta, &gamma, &theta, &vega}) {
+            if (i < column->size()) column->erase(column->begin() + i);
+        }
+        isCall.erase(isCall.begin() + i);
+        contractId.erase(contractId.begin() + i);
+    };
+
+    void resizeOutputs() {
+        price.assign(size(), 0.0);
+        delta.assign(size(), 0.0);
+        gamma.assign(size(), 0.0);
+        theta.assign(size(), 0.0);
+        vega.assign(size(), 0.0);
+    };
+};
+
+/*
+ * Abstract OptionPricer class that defines the interface for all pricers
+ *
+ * Batches are priced on a persistent pool of numThreads - 1 workers plus the
+ * calling thread, started on the first multi-threaded call, so pricing on
+ * every bar does not pay for thread creation. Contracts are handed out in
+ * small ranges so uneven contracts balance across threads.
+ */
+class OptionPricer {
+   public:
+    unsigned int numThreads;  // Threads used by priceBatch, caller included
+
+    OptionPricer(unsigned int numThreads = 0) {
+        this->numThreads =
+            numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+    };
+
+    OptionPricer(const OptionPricer&) = delete;
+    OptionPricer& operator=(const OptionPricer&) = delete;
+
+    virtual ~OptionPricer() {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (auto& worker : workers) worker.join();
+    };
+
+    // Prices every contract of the batch. Each contract only writes its own
+    // outputs; calls from several threads are serialised.
+    void priceBatch(OptionBatch& batch) {
+        auto n = batch.size();
+        if (batch.strike.size() != n || batch.maturity.size() != n ||
+            batch.rate.size() != n || batch.dividend.size() != n ||
+            batch.volatility.size() != n || batch.isCall.size() != n ||
+            batch.contractId.size() != n)
+            throw std::invalid_argument("OptionBatch inputs have mismatched sizes");
+
+        std::lock_guard<std::mutex> batchLock(batchMutex);
+        batch.resizeOutputs();
+        if (numThreads <= 1 || n <= 1) {
+            priceRange(batch, 0, n);
+            return;
+        }
+
+        if (workers.empty()) {
+            for (unsigned int i = 1; i < numThreads; ++i)
+                workers.emplace_back(&OptionPricer::workerLoop, this);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            jobBatch = &batch;
+            jobSize = n;
+            jobRangeSize = std::max<std::size_t>(1, n / (4 * numThreads));
+            nextIndex = 0;
+            remaining = n;
+            jobError = nullptr;
+            ++jobGeneration;
+        }
+        jobReady.notify_all();
+        priceJobRanges();
+
+        std::unique_lock<std::mutex> lock(poolMutex);
+        jobDone.wait(lock, [this] { return remaining == 0; });
+        jobBatch = nullptr;
+        if (jobError) std::rethrow_exception(jobError);
+    };
+
+   protected:
+    // Prices contracts [begin, end) of the batch
+    virtual void priceRange(OptionBatch& batch, std::size_t begin,
+                            std::size_t end) = 0;
+
+   private:
+    std::vector<std::thread> workers;
+    std::mutex batchMutex;  // Serialises priceBatch calls
+    std::mutex poolMutex;   // Guards the job state below
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    OptionBatch* jobBatch = nullptr;
+    std::size_t jobSize = 0;
+    std::size_t jobRangeSize = 1;
+    std::size_t nextIndex = 0;  // First contract not handed out yet
+    std::size_t remaining = 0;  // Contracts not priced yet
+    std::uint64_t jobGeneration = 0;
+    std::exception_ptr jobError;
+    bool stopping = false;
+
+    void workerLoop() {
+        std::uint64_t seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(poolMutex);
+        while (true) {
+            jobReady.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = jobGeneration;
+            lock.unlock();
+            priceJobRanges();
+            lock.lock();
+        }
+    };
+
+    // Takes ranges of the current job until none is left
+    void priceJobRanges() {
+        while (true) {
+            OptionBatch* batch;
+            std::size_t begin, end;
+            {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                if (!jobBatch || nextIndex >= jobSize) return;
+                batch = jobBatch;
+                begin = nextIndex;
+                end = std::min(jobSize, begin + jobRangeSize);
+                nextIndex = end;
+            }
+
+            std::exception_ptr error;
+            try {
+                priceRange(*batch, begin, end);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (error && !jobError) jobError = error;
+            remaining -= end - begin;
+            if (remaining == 0) jobDone.notify_all();
+        }
+    };
+};
+
+/*
+ * Cox-Ross-Rubinstein binomial lattice for American vanilla options
+ *
+ * Only one row of the tree is kept in memory; the backward induction over
+ * that row is branch-free so the compiler can vectorise it. Delta, gamma and
+ * theta are read from the first levels of the tree, vega is computed by
+ * central differences on the volatility.
+ */
+class BinomialOptionPricer : public OptionPricer {
+   public:
+    int steps;           // Number of binomial steps
+    double vegaBump;     // Absolute volatility bump used for vega
+
+    BinomialOptionPricer(int steps = 200, unsigned int numThreads = 0,
+                         double vegaBump = 0.01)
+        : OptionPricer(numThreads) {
+        // Greeks are read from level 2 of the tree, so it must be an
+        // intermediate level and not the terminal payoff
+        if (steps < 3) throw std::invalid_argument("Binomial pricer needs at least 3 steps");
+        this->steps = steps;
+        this->vegaBump = vegaBump;
+    };
+
+    // Tree values needed to extract price and Greeks
+    struct TreeResult {
+        double price;
+        double level1[2];
+        double level2[3];
+    };
+
+    // Price, delta, gamma and theta of one contract on a lattice of `steps`
+    // (>= 3) steps, using scratch rows of at least steps + 1 values
+    static TreeResult priceOnTree(int steps, double S, double K, double T, double r,
+                                  double q, double sigma, double phi,
+                                  std::vector<double>& values, std::vector<double>& spots,
+                                  double& delta, double& gamma, double& theta) {
+        auto tree = backwardInduction(steps, S, K, T, r, q, sigma, phi, values, spots);
+        double dt = T / steps;
+        double u = std::exp(sigma * std::sqrt(dt));
+        double d = 1.0 / u;
+
+        double Su = S * u, Sd = S * d, Suu = S * u * u, Sdd = S * d * d;
+        delta = (tree.level1[1] - tree.level1[0]) / (Su - Sd);
+        gamma = ((tree.level2[2] - tree.level2[1]) / (Suu - S) -
+                 (tree.level2[1] - tree.level2[0]) / (S - Sdd)) /
+                (0.5 * (Suu - Sdd));
+        theta = (tree.level2[1] - tree.price) / (2.0 * dt);
+        return tree;
+    };
+
+    static TreeResult backwardInduction(int steps, double S, double K, double T,
+                                        double r, double q, double sigma, double phi,
+                                        std::vector<double>& values,
+                                        std::vector<double>& spots) {
+        double dt = T / steps;
+        double u = std::exp(sigma * std::sqrt(dt));
+        double d = 1.0 / u;
+        double p = (std::exp((r - q) * dt) - d) / (u - d);
+        double discount = std::exp(-r * dt);
+        double pUp = discount * p, pDown = discount * (1.0 - p);
+        double* v = values.data();
+        double* s = spots.data();
+
+        // Payoff at maturity, node j has j up moves: S * u^j * d^(N - j)
+        s[0] = S * std::pow(d, steps);
+        for (int j = 1; j <= steps; ++j) s[j] = s[j - 1] * u * u;
+        for (int j = 0; j <= steps; ++j) v[j] = std::max(phi * (s[j] - K), 0.0);
+
+        TreeResult result{};
+        for (int level = steps - 1; level >= 0; --level) {
+            // Moving one level back multiplies every node price by u
+            for (int j = 0; j <= level; ++j) {
+                s[j] *= u;
+                double continuation = pUp * v[j + 1] + pDown * v[j];
+                v[j] = std::max(continuation, phi * (s[j] - K));
+            }
+            if (level == 2) std::copy(v, v + 3, result.level2);
+            if (level == 1) std::copy(v, v + 2, result.level1);
+        }
+        result.price = v[0];
+        return result;
+    };
+
+   protected:
+    void priceRange(OptionBatch& batch, std::size_t begin, std::size_t end) {
+        // Scratch rows reused for all the contracts of this range
+        std::vector<double> values(steps + 1);
+        std::vector<double> spots(steps + 1);
+
+        for (auto i = begin; i < end; ++i) {
+            double S = batch.spot[i], K = batch.strike[i], T = batch.maturity[i];
+            double r = batch.rate[i], q = batch.dividend[i], sigma = batch.volatility[i];
+            double phi = batch.isCall[i] ? 1.0 : -1.0;
+
+            if (T <= 0.0 || sigma <= 0.0) {
+                batch.price[i] = std::max(phi * (S - K), 0.0);
+                batch.delta[i] = batch.price[i] > 0.0 ? phi : 0.0;
+                continue;
+            }
+
+            batch.price[i] = priceOnTree(steps, S, K, T, r, q, sigma, phi, values, spots,
+                                         batch.delta[i], batch.gamma[i], batch.theta[i])
+                                 .price;
+
+            double sigmaDown = std::max(sigma - vegaBump, 0.5 * sigma);
+            double sigmaUp = sigma + vegaBump;
+            auto up = backwardInduction(steps, S, K, T, r, q, sigmaUp, phi, values, spots);
+            auto down = backwardInduction(steps, S, K, T, r, q, sigmaDown, phi, values, spots);
+            batch.vega[i] = (up.price - down.price) / (sigmaUp - sigmaDown);
+        }
+    };
+};
+
+/*
+ * Longstaff-Schwartz least-squares Monte Carlo for American vanilla options
+ *
+ * Paths follow an exact GBM discretisation with antithetic variates. At every
+ * exercise date the discounted cash flows of in-the-money paths are regressed
+ * on {1, x, x^2} (x = S / K) to estimate the continuation value. Each contract
+ * is seeded from its contractId, so its random stream does not depend on
+ * numThreads or on the other contracts of the batch.
+ *
+ * Delta and vega are obtained by bump-and-reprice on the same random numbers
+ * and with the exercise rule (regression coefficients) fitted on the base run.
+ * Finite differences of Monte Carlo prices are too noisy for gamma and theta
+ * (a time bump also changes every path), so those two are read from a
+ * binomial lattice of `latticeSteps` steps instead.
+ */
+class LongstaffSchwartzOptionPricer : public OptionPricer {
+   public:
+    int paths;           // Simulated paths (rounded up to an even number)
+    int steps;           // Exercise dates per contract
+    std::uint64_t seed;  // Base seed of the random number generator
+    double deltaBump;    // Relative spot bump used for delta
+    int latticeSteps;    // Binomial steps used for gamma and theta
+
+    LongstaffSchwartzOptionPricer(int paths = 10000, int steps = 50,
+                                  unsigned int numThreads = 0,
+                                  std::uint64_t seed = 42,
+                                  double deltaBump = 0.01, int latticeSteps = 500)
+        : OptionPricer(numThreads) {
+        if (paths < 2 || steps < 1)
+            throw std::invalid_argument("Longstaff-Schwartz pricer needs paths >= 2 and steps >= 1");
+        if (latticeSteps < 3)
+            throw std::invalid_argument("Longstaff-Schwartz pricer needs latticeSteps >= 3");
+        this->paths = paths + (paths % 2);
+        this->steps = steps;
+        this->seed = seed;
+        this->deltaBump = deltaBump;
+        this->latticeSteps = latticeSteps;
+    };
+
+   protected:
+    void priceRange(OptionBatch& batch, std::size_t begin, std::size_t end) {
+        // Standard normal draws (steps x paths / 2) and per-path scratch rows
+        std::vector<double> normals(static_cast<std::size_t>(steps) * (paths / 2));
+        std::vector<double> logSpots(static_cast<std::size_t>(steps) * paths);
+        std::vector<double> cashflows(paths);
+        std::vector<double> exerciseRule(3 * static_cast<std::size_t>(steps));
+        std::vector<double> latticeValues(latticeSteps + 1);
+        std::vector<double> latticeSpots(latticeSteps + 1);
+
+        for (auto i = begin; i < end; ++i) {
+            double S = batch.spot[i], K = batch.strike[i], T = batch.maturity[i];
+            double r = batch.rate[i], q = batch.dividend[i], sigma = batch.volatility[i];
+            double phi = batch.isCall[i] ? 1.0 : -1.0;
+
+            if (T <= 0.0 || sigma <= 0.0) {
+                batch.price[i] = std::max(phi * (S - K), 0.0);
+                batch.delta[i] = batch.price[i] > 0.0 ? phi : 0.0;
+                continue;
+            }
+
+            std::mt19937_64 generator(seed + batch.contractId[i]);
+            std::normal_distribution<double> normal(0.0, 1.0);
+            for (auto& z : normals) z = normal(generator);
+
+            // Base run fits the exercise rule, bumped runs reuse it
+            double price = simulate(S, K, T, r, q, sigma, phi, normals, logSpots,
+                                    cashflows, exerciseRule, true);
+            auto value = [&](double spot, double vol) {
+                return simulate(spot, K, T, r, q, vol, phi, normals,
+                                logSpots, cashflows, exerciseRule, false);
+            };
+
+            double dS = deltaBump * S, dSigma = 0.01;
+
+            batch.price[i] = price;
+            batch.delta[i] = (value(S + dS, sigma) - value(S - dS, sigma)) / (2.0 * dS);
+            double latticeDelta;
+            BinomialOptionPricer::priceOnTree(latticeSteps, S, K, T, r, q, sigma, phi,
+                                              latticeValues, latticeSpots, latticeDelta,
+                                              batch.gamma[i], batch.theta[i]);
+            batch.vega[i] = (value(S, sigma + dSigma) -
+                             value(S, std::max(sigma - dSigma, 0.5 * sigma))) /
+                            (sigma + dSigma - std::max(sigma - dSigma, 0.5 * sigma));
+        }
+    };
+
+    double simulate(double S, double K, double T, double r, double q, double sigma,
+                    double phi, const std::vector<double>& normals,
+                    std::vector<double>& logSpots, std::vector<double>& cashflows,
+                    std::vector<double>& exerciseRule, bool fitExerciseRule) const {
+        double dt = T / steps;
+        double drift = (r - q - 0.5 * sigma * sigma) * dt;
+        double diffusion = sigma * std::sqrt(dt);
+        double discount = std::exp(-r * dt);
+        int half = paths / 2;
+
+        // Log-spot paths stored step-major: logSpots[t * paths + m]
+        double logS0 = std::log(S);
+        for (int t = 0; t < steps; ++t) {
+            const double* z = normals.data() + static_cast<std::size_t>(t) * half;
+            const double* prev = t == 0 ? nullptr : logSpots.data() + (t - 1) * static_cast<std::size_t>(paths);
+            double* row = logSpots.data() + static_cast<std::size_t>(t) * paths;
+            for (int m = 0; m < half; ++m) {
+                double base = prev ? prev[m] : logS0;
+                double baseAnti = prev ? prev[m + half] : logS0;
+                row[m] = base + drift + diffusion * z[m];
+                row[m + half] = baseAnti + drift - diffusion * z[m];
+            }
+        }
+
+        // Exercise value at maturity
+        const double* last = logSpots.data() + static_cast<std::size_t>(steps - 1) * paths;
+        for (int m = 0; m < paths; ++m)
+            cashflows[m] = std::max(phi * (std::exp(last[m]) - K), 0.0);
+
+        // Backward induction over the exercise dates
+        for (int t = steps - 2; t >= 0; --t) {
+            const double* row = logSpots.data() + static_cast<std::size_t>(t) * paths;
+            double* beta = exerciseRule.data() + 3 * static_cast<std::size_t>(t);
+            for (int m = 0; m < paths; ++m) cashflows[m] *= discount;
+
+            if (fitExerciseRule) {
+                // Normal equations of the regression on {1, x, x^2}
+                double sums[5] = {0.0, 0.0, 0.0, 0.0, 0.0};  // sum of x^0 .. x^4
+                double rhs[3] = {0.0, 0.0, 0.0};
+                for (int m = 0; m < paths; ++m) {
+                    double spot = std::exp(row[m]);
+                    if (phi * (spot - K) <= 0.0) continue;
+                    double x = spot / K, x2 = x * x;
+                    double y = cashflows[m];
+                    sums[0] += 1.0;
+                    sums[1] += x;
+                    sums[2] += x2;
+                    sums[3] += x2 * x;
+                    sums[4] += x2 * x2;
+                    rhs[0] += y;
+                    rhs[1] += y * x;
+                    rhs[2] += y * x2;
+                }
+
+                // NaN marks a date without enough data to exercise on
+                if (sums[0] < 3.0 || !solveNormalEquations(sums, rhs, beta))
+                    beta[0] = std::numeric_limits<double>::quiet_NaN();
+            }
+            if (std::isnan(beta[0])) continue;
+
+            for (int m = 0; m < paths; ++m) {
+                double spot = std::exp(row[m]);
+                double exercise = phi * (spot - K);
+                if (exercise <= 0.0) continue;
+                double x = spot / K;
+                double continuation = beta[0] + beta[1] * x + beta[2] * x * x;
+                if (exercise > continuation) cashflows[m] = exercise;
+            }
+        }
+
+        double mean = 0.0;
+        for (int m = 0; m < paths; ++m) mean += cashflows[m];
+        mean = discount * mean / paths;
+
+        // Early exercise at t = 0
+        return std::max(mean, phi * (S - K));
+    };
+
+    // Solves the symmetric 3x3 system [s0 s1 s2; s1 s2 s3; s2 s3 s4] beta = rhs
+    // by Cramer's rule. Returns false when the system is (near) singular.
+    static bool solveNormalEquations(const double* s, const double* rhs, double* beta) {
+        auto det3 = [](double a, double b, double c, double d, double e, double f,
+                       double g, double h, double k) {
+            return a * (e * k - f * h) - b * (d * k - f * g) + c * (d * h - e * g);
+        };
+        double det = det3(s[0], s[1], s[2], s[1], s[2], s[3], s[2], s[3], s[4]);
+        if (std::abs(det) < 1e-12 * std::max(1.0, s[0] * s[0] * s[0])) return false;
+
+        beta[0] = det3(rhs[0], s[1], s[2], rhs[1], s[2], s[3], rhs[2], s[3], s[4]) / det;
+        beta[1] = det3(s[0], rhs[0], s[2], s[1], rhs[1], s[3], s[2], rhs[2], s[4]) / det;
+        beta[2] = det3(s[0], s[1], rhs[0], s[1], s[2], rhs[1], s[2], s[3], rhs[2]) / det;
+        return true;
+    };
+};
@@ -1,7 +1,12 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <queue>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -9,6 +14,7 @@
 #include "data.hpp"
 #include "event.hpp"
 #include "execution.hpp"
+#include "options.hpp"
 
 using SharedSignalEventType = std::shared_ptr<SignalEvent>;
 using SharedFillEventType = std::shared_ptr<FillEvent>;
@@ -42,6 +48,15 @@ class BasicPortfolio : Portfolio, std::enable_shared_from_this<BasicPortfolio> {
     PositionsType currentHoldings;
     // performance metrics
     MetricsType performanceMetrics;
+    // option contracts held, marked to model on every update()
+    OptionBatch optionHoldings;
+    std::vector<std::string> optionUnderlyings;
+    std::vector<long long> optionExpiries;
+    std::vector<double> optionQuantities;
+    std::shared_ptr<OptionPricer> optionPricer;
+    // bar timestamp units per year, used to derive option maturities
+    // (seconds by default)
+    double timestampsPerYear = 365.0 * 24 * 3600;
 
     BasicPortfolio(std::shared_ptr<SymbolsType> symbols,
                    std::shared_ptr<double> initialCapital,
@@ -87,6 +102,7 @@ class BasicPortfolio : Portfolio, std::enable_shared_from_this<BasicPortfolio> {
         innerMap.insert({"cash", *initialCapital});
         innerMap.insert({"commission", 0.0});
         innerMap.insert({"slippage", 0.0});
+        innerMap.insert({"options", 0.0});
         innerMap.insert({"total", *initialCapital});
         innerMap.insert({"returns", 0.0});
         innerMap.insert({"equity_curve", 0.0});
@@ -105,12 +121,13 @@ class BasicPortfolio : Portfolio, std::enable_shared_from_this<BasicPortfolio> {
         map.insert({"cash", *initialCapital});
         map.insert({"commission", 0.0});
         map.insert({"slippage", 0.0});
+        map.insert({"options", 0.0});
         map.insert({"total", *initialCapital});
         return map;
     };
 
     void update() {
-        float notCash = 0.0;
+        double notCash = 0.0;
         auto prevTotal = allHoldings.rbegin()->second["total"];
         auto prevEquityCurve = allHoldings.rbegin()->second["equity_curve"];
         auto symbol_to_use = (*symbols)[0];
@@ -124,6 +141,8 @@ class BasicPortfolio : Portfolio, std::enable_shared_from_this<BasicPortfolio> {
             currentHoldings[symbol] = currentValue;
             notCash += currentValue;
         }
+        notCash += markOptionHoldings();
+        allHoldings[timestamp]["options"] = currentHoldings["options"];
 
         currentHoldings["total"] = currentHoldings["cash"] + notCash;
         allHoldings[timestamp]["total"] = currentHoldings["total"];
@@ -139,6 +158,82 @@ class BasicPortfolio : Portfolio, std::enable_shared_from_this<BasicPortfolio> {
         }
     };
 
+    // adds an option contract on `underlying` (one of the portfolio symbols)
+    // expiring at `expiry` (a bar timestamp); quantity is signed (negative for
+    // written options). The premium, priced at the latest consumed bar of the
+    // underlying, and its commission are settled in cash.
+    void addOptionHolding(std::string underlying, double strike, long long expiry,
+                          double rate, double dividend, double volatility,
+                          bool isCall, double quantity) {
+        if (std::find(symbols->begin(), symbols->end(), underlying) == symbols->end())
+            throw std::invalid_argument("Unknown option underlying " + underlying);
+        if (!optionPricer)
+            throw std::runtime_error("Set optionPricer before adding option holdings");
+
+        auto& bars = dataHandler->consumedData[underlying];
+        if (bars.empty()) throw std::runtime_error("No bar consumed yet for " + underlying);
+        auto now = bars.rbegin()->first;
+        auto spot = std::get<3>(bars.rbegin()->second);
+        if (expiry <= now) throw std::invalid_argument("Option expiry is not in the future");
+
+        // priced under the id the holding gets, so it is marked on the same
+        // random numbers as long as it is held
+        OptionBatch contract;
+        contract.nextContractId = optionHoldings.nextContractId;
+        contract.add(spot, strike, (expiry - now) / timestampsPerYear, rate,
+                     dividend, volatility, isCall);
+        optionPricer->priceBatch(contract);
+
+        // same commission model as FillEvent::computeCommission
+        auto premium = quantity * contract.price[0];
+        auto commission = 0.001 * std::abs(premium);
+        currentHoldings["cash"] -= premium + commission;
+        currentHoldings["commission"] += commission;
+        currentHoldings["options"] += premium;
+        currentHoldings["total"] -= commission;
+
+        optionHoldings.add(spot, strike, contract.maturity[0], rate, dividend,
+                           volatility, isCall);
+        optionUnderlyings.push_back(underlying);
+        optionExpiries.push_back(expiry);
+        optionQuantities.push_back(quantity);
+    };
+
+    // settles expired option holdings at intrinsic value, then prices the
+    // others in one batch against the latest close of their underlying and
+    // returns their total value
+    double markOptionHoldings() {
+        for (std::size_t i = optionHoldings.size(); i-- > 0;) {
+            auto& latest = *dataHandler->consumedData.at(optionUnderlyings[i]).rbegin();
+            optionHoldings.spot[i] = std::get<3>(latest.second);
+
+            if (latest.first < optionExpiries[i]) {
+                optionHoldings.maturity[i] =
+                    (optionExpiries[i] - latest.first) / timestampsPerYear;
+                continue;
+            }
+
+            auto phi = optionHoldings.isCall[i] ? 1.0 : -1.0;
+            auto intrinsic = std::max(phi * (optionHoldings.spot[i] - optionHoldings.strike[i]), 0.0);
+            currentHoldings["cash"] += optionQuantities[i] * intrinsic;
+
+            optionHoldings.erase(i);
+            optionUnderlyings.erase(optionUnderlyings.begin() + i);
+            optionExpiries.erase(optionExpiries.begin() + i);
+            optionQuantities.erase(optionQuantities.begin() + i);
+        }
+
+        double optionsValue = 0.0;
+        if (optionHoldings.size() > 0) {
+            optionPricer->priceBatch(optionHoldings);
+            for (std::size_t i = 0; i < optionHoldings.size(); ++i) {
+                optionsValue += optionQuantities[i] * optionHoldings.price[i];
+            }
+        }
+        currentHoldings["options"] = optionsValue;
+        return optionsValue;
+    };
+
     void onSignal(SharedSignalEventType event) {
         generateOrder(event);
     };
@@ -181,7 +276,8 @@ class BasicPortfolio : Portfolio, std::enable_shared_from_this<BasicPortfolio> {
     void createOrderonFill(SharedFillEventType);
 
     void generateOrder(SharedSignalEventType event) {
-        float quantity = 1.0;
+        double quantity = 1.0;
+        std::string orderType = "MARKET";
         std::string direction;{
         if (event->signal > 0) {
             direction = "LONG";
@@ -189,12 +285,47 @@ class BasicPortfolio : Portfolio, std::enable_shared_from_this<BasicPortfolio> {
             direction = "SHORT";
         }
         eventQueue->push(std::make_shared<OrderEvent>(
-            &event->symbol, "MARKET", &quantity, &direction, event->target));
+            &event->symbol, &orderType, &quantity, &direction, event->target));
         }
     };
 
     auto getMaximumQuantity(SharedSignalEventType event);
 
-    // computes and returns performace metrics
-    void getMetrics();
+    // computes and prints performance metrics of the equity curve
+    // (see create_sharpe_ratio and create_drawdowns in performance.py)
+    void getMetrics(double periods = 252 * 60 * 6.5) {
+        std::vector<double> returns;
+        double meanReturn = 0.0, highWaterMark = 0.0, maxDrawdown = 0.0;
+        double duration = 0.0, maxDuration = 0.0;
+        for (auto it = std::next(allHoldings.begin()); it != allHoldings.end(); ++it) {
+            returns.push_back(it->second["returns"]);
+            meanReturn += returns.back();
+
+            auto equityCurve = it->second["equity_curve"];
+            highWaterMark = std::max(highWaterMark, equityCurve);
+            auto drawdown = highWaterMark - equityCurve;
+            duration = drawdown == 0.0 ? 0.0 : duration + 1.0;
+            maxDrawdown = std::max(maxDrawdown, drawdown);
+            maxDuration = std::max(maxDuration, duration);
+        }
+
+        double sharpeRatio = 0.0;
+        if (!returns.empty()) {
+            meanReturn /= returns.size();
+            double variance = 0.0;
+            for (auto value : returns) variance += (value - meanReturn) * (value - meanReturn);
+            double deviation = std::sqrt(variance / returns.size());
+            if (deviation > 0.0) sharpeRatio = std::sqrt(periods) * meanReturn / deviation;
+        }
+
+        performanceMetrics["total_return"] = allHoldings.rbegin()->second["equity_curve"];
+        performanceMetrics["sharpe_ratio"] = sharpeRatio;
+        performanceMetrics["max_drawdown"] = maxDrawdown;
+        performanceMetrics["drawdown_duration"] = maxDuration;
+
+        std::cout << "Total Returns " << performanceMetrics["total_return"] * 100 << "\n"
+                  << "Sharpe Ratio " << sharpeRatio << "\n"
+                  << "Max Drawdown " << maxDrawdown << "\n"
+                  << "Drawdown Duration " << maxDuration << std::endl;
+    };
 };
\ No newline at end of file
@@ -7,14 +7,49 @@
     3. Communicating these signals to the Portfolio component via SignalEvents
 */
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "cache.hpp"
 #include "data.hpp"
 #include "event.hpp"
 
+/*
+ * Relative Strength Index over chronologically ordered closing prices
+ *
+ * Entry i uses closes[i - n .. i]: RSI = 100 - (100 / (1 + RS)) with RS the
+ * ratio of average gain to average loss over those n periods. The first n
+ * entries are NaN.
+ */
+inline IndicatorSeriesType computeRSI(const std::vector<double>& closes, int n) {
+    IndicatorSeriesType rsi(closes.size(), std::numeric_limits<double>::quiet_NaN());
+    if (n <= 0 || closes.size() <= static_cast<std::size_t>(n)) return rsi;
+
+    // Rolling sums of gains and losses over the last n price changes
+    double gains = 0.0, losses = 0.0;
+    for (std::size_t i = 1; i < closes.size(); ++i) {
+        double change = closes[i] - closes[i - 1];
+        gains += std::max(change, 0.0);
+        losses += std::max(-change, 0.0);
+
+        if (i > static_cast<std::size_t>(n)) {
+            double dropped = closes[i - n] - closes[i - n - 1];
+            gains -= std::max(dropped, 0.0);
+            losses -= std::max(-dropped, 0.0);
+        }
+        if (i >= static_cast<std::size_t>(n)) {
+            rsi[i] = losses <= 0.0 ? 100.0 : 100.0 - (100.0 / (1.0 + gains / losses));
+        }
+    }
+    return rsi;
+}
+
 /*
  * Abstract Strategy class that defines the interface for all trading strategies
  */
@@ -40,9 +75,21 @@ class TradingStrategy : Strategy {
     // This prevents the strategy from generating duplicate signals
     std::unordered_map<std::string, bool> bought;
 
+    // Optional cache of indicator series, shared across backtest runs
+    // When set, RSI is computed once per dataset instead of once per bar
+    std::shared_ptr<IndicatorCache> indicatorCache;
+
+    // RSI series over the whole dataset, resolved from indicatorCache
+    // (nullptr when the symbol cannot be cached), and the timestamp of each
+    // of its entries
+    std::unordered_map<std::string, SharedIndicatorSeriesType> rsiSeries;
+    std::unordered_map<std::string, std::vector<long long>> rsiTimestamps;
+
     // Constructor initializes the strategy with a data source
-    TradingStrategy(std::shared_ptr<HistoricCSVDataHandler> dataHandler) {
+    TradingStrategy(std::shared_ptr<HistoricCSVDataHandler> dataHandler,
+                    std::shared_ptr<IndicatorCache> indicatorCache = nullptr) {
         this->dataHandler = dataHandler;
+        this->indicatorCache = indicatorCache;
         this->eventQueue = dataHandler->eventQueue;
 
         std::unordered_map<std::string, bool> bought;
@@ -71,30 +118,10 @@ class TradingStrategy : Strategy {
             int n = 20;  // Lookback period for RSI calculation
             int direction = 0;  // Signal direction: 1=buy, -1=sell, 0=no action
 
-            // Container for closing prices
-            std::vector<double> closes;
-            closes.reserve(n + 1);
-
-            // Retrieve the latest n+1 bars for the current symbol
-            auto ptr_symbol = std::make_shared<std::string>(symbol);
-            auto data = dataHandler->getLatestBars(ptr_symbol, n + 1);
-            
+            // Compute the RSI over the latest n+1 bars
             // Skip if we don't have enough data for calculation
-            if (data.size() < n + 1) return;
-            
-            // Extract closing prices from the price bars
-            for (auto close : data) {
-                closes.emplace_back(std::get<3>(close));
-            }
-
-            // TODO: Compute the RSI
-            // Placeholder for actual RSI calculation
-            // In a complete implementation, this would calculate:
-            // 1. Price changes for each period
-            // 2. Average gains and losses over n periods
-            // 3. Relative strength (avg gain / avg loss)
-            // 4. RSI = 100 - (100 / (1 + RS))
-            double rsi = 20;  // Placeholder value
+            double rsi = latestRSI(symbol, n);
+            if (std::isnan(rsi)) return;
 
             // Generate trading signals based on RSI thresholds
             // RSI > 70 indicates overbought conditions (sell signal)
@@ -122,4 +149,68 @@ class TradingStrategy : Strategy {
             }
         }
     };
+
+    // Returns the RSI of the latest consumed bar, NaN if not enough data
+    double latestRSI(const std::string& symbol, int n) {
+        // Look the latest consumed bar up in the cached series; handlers may
+        // trim consumedData, so its size is not a position in the series
+        auto cached = cachedRSISeries(symbol, n);
+        auto& consumed = dataHandler->consumedData[symbol];
+        if (cached && !consumed.empty()) {
+            auto& timestamps = rsiTimestamps[symbol];
+            auto latest = consumed.rbegin()->first;
+            auto position = std::lower_bound(timestamps.begin(), timestamps.end(), latest);
+            if (position != timestamps.end() && *position == latest)
+                return (*cached)[static_cast<std::size_t>(position - timestamps.begin())];
+        }
+
+        // Retrieve the latest n+1 bars for the current symbol
+        auto ptr_symbol = std::make_shared<std::string>(symbol);
+        auto data = dataHandler->getLatestBars(ptr_symbol, n + 1);
+        if (data.size() < static_cast<std::size_t>(n + 1))
+            return std::numeric_limits<double>::quiet_NaN();
+
+        // Extract closing prices from the price bars (latest bar comes first)
+        std::vector<double> closes;
+        closes.reserve(n + 1);
+        for (auto rit = data.rbegin(); rit != data.rend(); ++rit) {
+            closes.emplace_back(std::get<3>(*rit));
+        }
+        return computeRSI(closes, n).back();
+    };
+
+    // Resolves the RSI series of the whole dataset through indicatorCache,
+    // computing and storing it on a miss. Returns nullptr when caching is
+    // not possible (no cache, or the dataset is not fully in memory).
+    SharedIndicatorSeriesType cachedRSISeries(const std::string& symbol, int n) {
+        if (!indicatorCache || dataHandler->datasetHash == 0) return nullptr;
+
+        auto it = rsiSeries.find(symbol);
+        if (it != rsiSeries.end()) return it->second;
+
+        auto dataIt = dataHandler->data.find(symbol);
+        if (dataIt == dataHandler->data.end() || dataIt->second.empty()) {
+            rsiSeries[symbol] = nullptr;
+            return nullptr;
+        }
+        auto& bars = dataIt->second;
+
+        IndicatorKey key{dataHandler->datasetHash, symbol, "RSI",
+                         {static_cast<double>(n)}, bars.begin()->first,
+                         bars.rbegin()->first};
+        auto series = indicatorCache->getOrCompute(key, [&bars, n] {
+            std::vector<double> closes;
+            closes.reserve(bars.size());
+            for (auto& bar : bars) closes.emplace_back(std::get<3>(bar.second));
+            return computeRSI(closes, n);
+        });
+
+        auto& timestamps = rsiTimestamps[symbol];
+        timestamps.clear();
+        timestamps.reserve(bars.size());
+        for (auto& bar : bars) timestamps.emplace_back(bar.first);
+
+        rsiSeries[symbol] = series;
+        return series;
+    };
 };